@@ -0,0 +1,189 @@
+/*
+ * ACCPages.h: C compatible layout of the ACC shared memory pages, for consumers of ACCSharedMemoryC.h.
+ *
+ * Mirrors the structs in SharedFileOut.h field for field, strings are UTF-16 code units.
+ * ACCSharedMemoryC.cpp checks every offset and size against SharedFileOut.h at compile time.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#pragma pack(push)
+#pragma pack(4)
+
+typedef struct acc_physics_page {
+    int32_t packetId;
+    float gas;
+    float brake;
+    float fuel;
+    int32_t gear;
+    int32_t rpms;
+    float steerAngle;
+    float speedKmh;
+    float velocity[3];
+    float accG[3];
+    float wheelSlip[4];
+    float wheelLoad[4];
+    float wheelsPressure[4];
+    float wheelAngularSpeed[4];
+    float tyreWear[4];
+    float tyreDirtyLevel[4];
+    float tyreCoreTemperature[4];
+    float camberRAD[4];
+    float suspensionTravel[4];
+    float drs;
+    float tc;
+    float heading;
+    float pitch;
+    float roll;
+    float cgHeight;
+    float carDamage[5];
+    int32_t numberOfTyresOut;
+    int32_t pitLimiterOn;
+    float abs;
+    int32_t autoShifterOn;
+    float turboBoost;
+    float airTemp;
+    float roadTemp;
+    float localAngularVel[3];
+    float finalFF;
+    float brakeTemp[4];
+    float clutch;
+    int32_t isAIControlled;
+    float tyreContactPoint[4][3];
+    float tyreContactNormal[4][3];
+    float tyreContactHeading[4][3];
+    float brakeBias;
+    float localVelocity[3];
+    float slipRatio[4];
+    float slipAngle[4];
+    float waterTemp;
+    float brakePressure[4];
+    int32_t frontBrakeCompound;
+    int32_t rearBrakeCompound;
+    float padLife[4];
+    float discLife[4];
+    int32_t ignitionOn;
+    int32_t starterEngineOn;
+    int32_t isEngineRunning;
+    float kerbVibration;
+    float slipVibrations;
+    float gVibrations;
+    float absVibrations;
+} acc_physics_page;
+
+typedef struct acc_graphics_page {
+    int32_t packetId;
+    int32_t status;
+    int32_t session;
+    uint16_t currentTime[15];
+    uint16_t lastTime[15];
+    uint16_t bestTime[15];
+    uint16_t split[15];
+    int32_t completedLaps;
+    int32_t position;
+    int32_t iCurrentTime;
+    int32_t iLastTime;
+    int32_t iBestTime;
+    float sessionTimeLeft;
+    float distanceTraveled;
+    int32_t isInPit;
+    int32_t currentSectorIndex;
+    int32_t lastSectorTime;
+    int32_t numberOfLaps;
+    uint16_t tyreCompound[33];
+    float normalizedCarPosition;
+    int32_t activeCars;
+    float carCoordinates[60][3];
+    int32_t carID[60];
+    int32_t playerCarID;
+    float penaltyTime;
+    int32_t flag;
+    int32_t penalty;
+    int32_t idealLineOn;
+    int32_t isInPitLane;
+    float surfaceGrip;
+    int32_t mandatoryPitDone;
+    float windSpeed;
+    float windDirection;
+    int32_t isSetupMenuVisible;
+    int32_t mainDisplayIndex;
+    int32_t secondaryDisplayIndex;
+    int32_t TC;
+    int32_t TCCut;
+    int32_t EngineMap;
+    int32_t ABS;
+    int32_t fuelXLap;
+    int32_t rainLights;
+    int32_t flashingLights;
+    int32_t lightsStage;
+    float exhaustTemperature;
+    int32_t wiperLV;
+    int32_t DriverStintTotalTimeLeft;
+    int32_t DriverStintTimeLeft;
+    int32_t rainTyres;
+    int32_t sessionIndex;
+    float usedFuel;
+    uint16_t deltaLapTime[15];
+    int32_t iDeltaLapTime;
+    uint16_t estimatedLapTime[15];
+    int32_t iEstimatedLapTime;
+    int32_t isDeltaPositive;
+    int32_t iSplit;
+    int32_t isValidLap;
+    float fuelEstimatedLaps;
+    uint16_t trackStatus[33];
+    int32_t missingMandatoryPits;
+    float Clock;
+    int32_t directionLightsLeft;
+    int32_t directionLightsRight;
+    int32_t GlobalYellow;
+    int32_t GlobalYellow1;
+    int32_t GlobalYellow2;
+    int32_t GlobalYellow3;
+    int32_t GlobalWhite;
+    int32_t GlobalGreen;
+    int32_t GlobalChequered;
+    int32_t GlobalRed;
+    int32_t mfdTyreSet;
+    float mfdFuelToAdd;
+    float mfdTyrePressureLF;
+    float mfdTyrePressureRF;
+    float mfdTyrePressureLR;
+    float mfdTyrePressureRR;
+    int32_t currentTyreSet;
+    int32_t strategyTyreSet;
+    int32_t gapAhead;
+    int32_t gapBehind;
+} acc_graphics_page;
+
+typedef struct acc_static_page {
+    uint16_t smVersion[15];
+    uint16_t acVersion[15];
+    int32_t numberOfSessions;
+    int32_t numCars;
+    uint16_t carModel[33];
+    uint16_t track[33];
+    uint16_t playerName[33];
+    uint16_t playerSurname[33];
+    uint16_t playerNick[33];
+    int32_t sectorCount;
+    int32_t maxRpm;
+    float maxFuel;
+    int32_t penaltiesEnabled;
+    float aidFuelRate;
+    float aidTireRate;
+    float aidMechanicalDamage;
+    int32_t aidAllowTyreBlankets;
+    float aidStability;
+    int32_t aidAutoClutch;
+    int32_t aidAutoBlip;
+    int32_t PitWindowStart;
+    int32_t PitWindowEnd;
+    int32_t isOnline;
+    uint16_t dryTyresName[33];
+    uint16_t wetTyresName[33];
+} acc_static_page;
+
+#pragma pack(pop)
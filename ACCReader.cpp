@@ -0,0 +1,68 @@
+/*
+ * ACCReader.cpp: Mapping and access checks of the native reading core.
+*/
+
+#include "ACCReader.h"
+
+using namespace std;
+
+ACCReader::ACCReader(const string &kind) {
+    setBackend(kind);
+}
+
+void ACCReader::setBackend(const string &kind) {
+    // throws for backends that are not available on this platform
+    createMappingBackend(kind);
+    backendKind = kind;
+}
+
+unique_ptr<MappingBackend> ACCReader::map(const string &name, size_t size, bool prefault) const {
+    unique_ptr<MappingBackend> mapping = createMappingBackend(backendKind);
+    mapping->open(name, size, prefault);
+    return mapping;
+}
+
+void ACCReader::initPhysics(bool prefault) {
+    physicsMapping = map("acpmf_physics", sizeof(SPageFilePhysics), prefault);
+}
+
+void ACCReader::initGraphics(bool prefault) {
+    graphicsMapping = map("acpmf_graphics", sizeof(SPageFileGraphic), prefault);
+}
+
+void ACCReader::initStatic(bool prefault) {
+    staticMapping = map("acpmf_static", sizeof(SPageFileStatic), prefault);
+}
+
+bool ACCReader::isPhysicsReady() const {
+    return physicsMapping && PhysicsView(physicsMapping->data()).packetId() != 0;
+}
+
+bool ACCReader::isGraphicsReady() const {
+    return graphicsMapping && GraphicsView(graphicsMapping->data()).packetId() != 0;
+}
+
+bool ACCReader::isStaticReady() const {
+    return staticMapping && StaticView(staticMapping->data())->smVersion[0] != 0;
+}
+
+PhysicsView ACCReader::physics() const {
+    if (!physicsMapping) {
+        throw MappingError("Physics shared memory is not initialized, call initPhysics() first");
+    }
+    return PhysicsView(physicsMapping->data());
+}
+
+GraphicsView ACCReader::graphics() const {
+    if (!graphicsMapping) {
+        throw MappingError("Graphics shared memory is not initialized, call initGraphics() first");
+    }
+    return GraphicsView(graphicsMapping->data());
+}
+
+StaticView ACCReader::staticData() const {
+    if (!staticMapping) {
+        throw MappingError("Static shared memory is not initialized, call initStatic() first");
+    }
+    return StaticView(staticMapping->data());
+}
@@ -0,0 +1,46 @@
+/*
+ * ACCReader.h: Native reading core, owns the mappings of the physics, graphics and static pages.
+ *              Used by the python module and by native consumers through the C++ or C API.
+*/
+
+#pragma once
+
+#include "ACCView.h"
+#include "MappingBackend.h"
+#include <memory>
+#include <string>
+
+class ACCReader {
+public:
+    explicit ACCReader(const std::string &backendKind = "default");
+
+    ACCReader(const ACCReader &) = delete;
+    ACCReader &operator=(const ACCReader &) = delete;
+
+    // kind: "default", "win32" or "posix", used by the next init call
+    void setBackend(const std::string &kind);
+    const std::string &backend() const { return backendKind; }
+
+    // throw MappingError when the page can not be mapped
+    void initPhysics(bool prefault = false);
+    void initGraphics(bool prefault = false);
+    void initStatic(bool prefault = false);
+
+    // non-blocking, true when the page is mapped and the game has written data to it
+    bool isPhysicsReady() const;
+    bool isGraphicsReady() const;
+    bool isStaticReady() const;
+
+    // throw MappingError when the page was never initialized
+    PhysicsView physics() const;
+    GraphicsView graphics() const;
+    StaticView staticData() const;
+
+private:
+    std::unique_ptr<MappingBackend> map(const std::string &name, size_t size, bool prefault) const;
+
+    std::string backendKind;
+    std::unique_ptr<MappingBackend> physicsMapping;
+    std::unique_ptr<MappingBackend> graphicsMapping;
+    std::unique_ptr<MappingBackend> staticMapping;
+};
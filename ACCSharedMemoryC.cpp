@@ -0,0 +1,336 @@
+/*
+ * ACCSharedMemoryC.cpp: C ABI wrapper around ACCReader and PacketWatcher. No exception crosses this boundary.
+*/
+
+#include "ACCSharedMemoryC.h"
+#include "ACCReader.h"
+#include "PacketWatcher.h"
+#include <cstddef>
+#include <exception>
+#include <string>
+
+using namespace std;
+
+// ACCPages.h has to match SharedFileOut.h byte for byte
+#define ACC_CHECK_FIELD(cType, cppType, field) \
+    static_assert(offsetof(cType, field) == offsetof(cppType, field) && \
+                  sizeof(((cType *) nullptr)->field) == sizeof(((cppType *) nullptr)->field), \
+                  #cType "." #field " differs from " #cppType)
+
+static_assert(sizeof(acc_physics_page) == sizeof(SPageFilePhysics), "acc_physics_page layout differs from SPageFilePhysics");
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, packetId);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, gas);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, brake);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, fuel);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, gear);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, rpms);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, steerAngle);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, speedKmh);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, velocity);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, accG);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, wheelSlip);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, wheelLoad);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, wheelsPressure);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, wheelAngularSpeed);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, tyreWear);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, tyreDirtyLevel);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, tyreCoreTemperature);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, camberRAD);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, suspensionTravel);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, drs);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, tc);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, heading);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, pitch);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, roll);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, cgHeight);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, carDamage);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, numberOfTyresOut);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, pitLimiterOn);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, abs);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, autoShifterOn);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, turboBoost);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, airTemp);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, roadTemp);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, localAngularVel);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, finalFF);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, brakeTemp);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, clutch);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, isAIControlled);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, tyreContactPoint);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, tyreContactNormal);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, tyreContactHeading);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, brakeBias);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, localVelocity);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, slipRatio);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, slipAngle);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, waterTemp);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, brakePressure);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, frontBrakeCompound);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, rearBrakeCompound);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, padLife);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, discLife);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, ignitionOn);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, starterEngineOn);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, isEngineRunning);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, kerbVibration);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, slipVibrations);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, gVibrations);
+ACC_CHECK_FIELD(acc_physics_page, SPageFilePhysics, absVibrations);
+
+static_assert(sizeof(acc_graphics_page) == sizeof(SPageFileGraphic), "acc_graphics_page layout differs from SPageFileGraphic");
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, packetId);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, status);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, session);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, currentTime);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, lastTime);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, bestTime);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, split);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, completedLaps);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, position);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, iCurrentTime);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, iLastTime);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, iBestTime);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, sessionTimeLeft);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, distanceTraveled);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, isInPit);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, currentSectorIndex);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, lastSectorTime);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, numberOfLaps);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, tyreCompound);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, normalizedCarPosition);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, activeCars);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, carCoordinates);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, carID);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, playerCarID);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, penaltyTime);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, flag);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, penalty);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, idealLineOn);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, isInPitLane);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, surfaceGrip);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, mandatoryPitDone);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, windSpeed);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, windDirection);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, isSetupMenuVisible);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, mainDisplayIndex);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, secondaryDisplayIndex);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, TC);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, TCCut);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, EngineMap);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, ABS);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, fuelXLap);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, rainLights);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, flashingLights);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, lightsStage);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, exhaustTemperature);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, wiperLV);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, DriverStintTotalTimeLeft);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, DriverStintTimeLeft);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, rainTyres);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, sessionIndex);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, usedFuel);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, deltaLapTime);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, iDeltaLapTime);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, estimatedLapTime);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, iEstimatedLapTime);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, isDeltaPositive);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, iSplit);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, isValidLap);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, fuelEstimatedLaps);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, trackStatus);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, missingMandatoryPits);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, Clock);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, directionLightsLeft);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, directionLightsRight);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, GlobalYellow);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, GlobalYellow1);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, GlobalYellow2);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, GlobalYellow3);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, GlobalWhite);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, GlobalGreen);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, GlobalChequered);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, GlobalRed);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, mfdTyreSet);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, mfdFuelToAdd);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, mfdTyrePressureLF);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, mfdTyrePressureRF);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, mfdTyrePressureLR);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, mfdTyrePressureRR);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, currentTyreSet);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, strategyTyreSet);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, gapAhead);
+ACC_CHECK_FIELD(acc_graphics_page, SPageFileGraphic, gapBehind);
+
+static_assert(sizeof(acc_static_page) == sizeof(SPageFileStatic), "acc_static_page layout differs from SPageFileStatic");
+ACC_CHECK_FIELD(acc_static_page, SPageFileStatic, smVersion);
+ACC_CHECK_FIELD(acc_static_page, SPageFileStatic, acVersion);
+ACC_CHECK_FIELD(acc_static_page, SPageFileStatic, numberOfSessions);
+ACC_CHECK_FIELD(acc_static_page, SPageFileStatic, numCars);
+ACC_CHECK_FIELD(acc_static_page, SPageFileStatic, carModel);
+ACC_CHECK_FIELD(acc_static_page, SPageFileStatic, track);
+ACC_CHECK_FIELD(acc_static_page, SPageFileStatic, playerName);
+ACC_CHECK_FIELD(acc_static_page, SPageFileStatic, playerSurname);
+ACC_CHECK_FIELD(acc_static_page, SPageFileStatic, playerNick);
+ACC_CHECK_FIELD(acc_static_page, SPageFileStatic, sectorCount);
+ACC_CHECK_FIELD(acc_static_page, SPageFileStatic, maxRpm);
+ACC_CHECK_FIELD(acc_static_page, SPageFileStatic, maxFuel);
+ACC_CHECK_FIELD(acc_static_page, SPageFileStatic, penaltiesEnabled);
+ACC_CHECK_FIELD(acc_static_page, SPageFileStatic, aidFuelRate);
+ACC_CHECK_FIELD(acc_static_page, SPageFileStatic, aidTireRate);
+ACC_CHECK_FIELD(acc_static_page, SPageFileStatic, aidMechanicalDamage);
+ACC_CHECK_FIELD(acc_static_page, SPageFileStatic, aidAllowTyreBlankets);
+ACC_CHECK_FIELD(acc_static_page, SPageFileStatic, aidStability);
+ACC_CHECK_FIELD(acc_static_page, SPageFileStatic, aidAutoClutch);
+ACC_CHECK_FIELD(acc_static_page, SPageFileStatic, aidAutoBlip);
+ACC_CHECK_FIELD(acc_static_page, SPageFileStatic, PitWindowStart);
+ACC_CHECK_FIELD(acc_static_page, SPageFileStatic, PitWindowEnd);
+ACC_CHECK_FIELD(acc_static_page, SPageFileStatic, isOnline);
+ACC_CHECK_FIELD(acc_static_page, SPageFileStatic, dryTyresName);
+ACC_CHECK_FIELD(acc_static_page, SPageFileStatic, wetTyresName);
+
+#undef ACC_CHECK_FIELD
+
+struct acc_reader {
+    ACCReader reader;
+    PacketWatcher watcher;
+
+    explicit acc_reader(const string &backend) : reader(backend) {}
+};
+
+static thread_local string lastError;
+
+static int fail(const exception &e) {
+    lastError = e.what();
+    return -1;
+}
+
+static int fail(const char *message) {
+    lastError = message;
+    return -1;
+}
+
+acc_reader *acc_open(const char *backend, int prefault) {
+    try {
+        acc_reader *reader = new acc_reader(backend ? backend : "default");
+        try {
+            reader->reader.initPhysics(prefault != 0);
+            reader->reader.initGraphics(prefault != 0);
+            reader->reader.initStatic(prefault != 0);
+        } catch (...) {
+            delete reader;
+            throw;
+        }
+        return reader;
+    } catch (const exception &e) {
+        fail(e);
+        return nullptr;
+    }
+}
+
+void acc_close(acc_reader *reader) {
+    delete reader;
+}
+
+const char *acc_last_error(void) {
+    return lastError.c_str();
+}
+
+int acc_abi_version(void) {
+    return ACC_ABI_VERSION;
+}
+
+size_t acc_page_size(int page) {
+    switch (page) {
+        case ACC_PAGE_PHYSICS:
+            return sizeof(SPageFilePhysics);
+        case ACC_PAGE_GRAPHICS:
+            return sizeof(SPageFileGraphic);
+        case ACC_PAGE_STATIC:
+            return sizeof(SPageFileStatic);
+        default:
+            return 0;
+    }
+}
+
+const void *acc_page_data(const acc_reader *reader, int page) {
+    if (!reader) {
+        fail("Reader is NULL");
+        return nullptr;
+    }
+    switch (page) {
+        case ACC_PAGE_PHYSICS:
+            return reader->reader.physics().get();
+        case ACC_PAGE_GRAPHICS:
+            return reader->reader.graphics().get();
+        case ACC_PAGE_STATIC:
+            return reader->reader.staticData().get();
+        default:
+            fail("Unknown page");
+            return nullptr;
+    }
+}
+
+int acc_read_page(const acc_reader *reader, int page, void *dst, size_t size) {
+    if (!reader || !dst) {
+        return fail("Reader or destination is NULL");
+    }
+    if (size < acc_page_size(page)) {
+        return fail("Destination is smaller than the page");
+    }
+
+    bool consistent = false;
+    switch (page) {
+        case ACC_PAGE_PHYSICS:
+            consistent = reader->reader.physics().snapshot(*(SPageFilePhysics *) dst);
+            break;
+        case ACC_PAGE_GRAPHICS:
+            consistent = reader->reader.graphics().snapshot(*(SPageFileGraphic *) dst);
+            break;
+        case ACC_PAGE_STATIC:
+            consistent = reader->reader.staticData().snapshot(*(SPageFileStatic *) dst);
+            break;
+        default:
+            return fail("Unknown page");
+    }
+    return consistent ? 0 : fail("Page changed during every copy attempt");
+}
+
+int acc_is_ready(const acc_reader *reader, int page) {
+    if (!reader) {
+        return 0;
+    }
+    switch (page) {
+        case ACC_PAGE_PHYSICS:
+            return reader->reader.isPhysicsReady();
+        case ACC_PAGE_GRAPHICS:
+            return reader->reader.isGraphicsReady();
+        case ACC_PAGE_STATIC:
+            return reader->reader.isStaticReady();
+        default:
+            return 0;
+    }
+}
+
+int acc_watch(acc_reader *reader, acc_packet_callback callback, void *user, unsigned pollMicros) {
+    if (!reader || !callback) {
+        return fail("Reader or callback is NULL");
+    }
+    try {
+        reader->watcher.onPhysics([callback, user](const SPageFilePhysics &packet) {
+            callback(ACC_PAGE_PHYSICS, &packet, sizeof(packet), user);
+        });
+        reader->watcher.onGraphics([callback, user](const SPageFileGraphic &packet) {
+            callback(ACC_PAGE_GRAPHICS, &packet, sizeof(packet), user);
+        });
+        reader->watcher.start(reader->reader, chrono::microseconds(pollMicros ? pollMicros : 1000));
+        return 0;
+    } catch (const exception &e) {
+        return fail(e);
+    }
+}
+
+void acc_unwatch(acc_reader *reader) {
+    if (reader) {
+        reader->watcher.stop();
+    }
+}
@@ -0,0 +1,69 @@
+/*
+ * ACCSharedMemoryC.h: Stable C ABI of the native reading core for consumers that can not use the C++ API.
+ *
+ * Pages are identified by ACC_PAGE_* and handed out in the layout of the structs in ACCPages.h
+ * (acc_physics_page, acc_graphics_page, acc_static_page).
+ * Functions returning int return 0 on success and -1 on failure, acc_last_error() describes the failure.
+*/
+
+#pragma once
+
+#include "ACCPages.h"
+#include <stddef.h>
+
+#if defined(ACC_STATIC)
+#define ACC_API
+#elif defined(_WIN32)
+#ifdef ACC_BUILDING_LIBRARY
+#define ACC_API __declspec(dllexport)
+#else
+#define ACC_API __declspec(dllimport)
+#endif
+#else
+#define ACC_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Bumped on every incompatible change of this header or ACCPages.h
+#define ACC_ABI_VERSION 1
+
+#define ACC_PAGE_PHYSICS 0
+#define ACC_PAGE_GRAPHICS 1
+#define ACC_PAGE_STATIC 2
+
+typedef struct acc_reader acc_reader;
+
+// Called on the watcher thread with a consistent copy of a physics or graphics page
+typedef void (*acc_packet_callback)(int page, const void *data, size_t size, void *user);
+
+// ACC_ABI_VERSION the library was built with, compare against the one the consumer was compiled with
+ACC_API int acc_abi_version(void);
+
+// backend: "default", "win32", "posix" or NULL for default. Maps all three pages, NULL on failure
+ACC_API acc_reader *acc_open(const char *backend, int prefault);
+ACC_API void acc_close(acc_reader *reader);
+
+// Message of the last failure on this thread, valid until the next failing call on this thread
+ACC_API const char *acc_last_error(void);
+
+ACC_API size_t acc_page_size(int page);
+
+// Zero-copy pointer into the mapping, fields may change while they are read
+ACC_API const void *acc_page_data(const acc_reader *reader, int page);
+
+// Consistent copy of the page into dst, size must be at least acc_page_size(page)
+ACC_API int acc_read_page(const acc_reader *reader, int page, void *dst, size_t size);
+
+// 1 when the game has written data to the page, 0 otherwise. Never blocks
+ACC_API int acc_is_ready(const acc_reader *reader, int page);
+
+// Start calling callback on every new physics and graphics packet, polled every pollMicros microseconds
+ACC_API int acc_watch(acc_reader *reader, acc_packet_callback callback, void *user, unsigned pollMicros);
+ACC_API void acc_unwatch(acc_reader *reader);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,70 @@
+/*
+ * ACCView.h: Header only zero-copy views on the mapped ACC shared memory pages.
+ *
+ * A view is a typed pointer into the mapping, reading a field reads the shared memory directly.
+ * snapshot() makes a consistent copy for consumers that need all fields from the same packet.
+*/
+
+#pragma once
+
+#include "SharedFileOut.h"
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+template<typename Page, typename = void>
+struct HasPacketId : std::false_type {};
+
+template<typename Page>
+struct HasPacketId<Page, std::void_t<decltype(&Page::packetId)>> : std::true_type {};
+
+template<typename Page>
+class PageView {
+public:
+    PageView() = default;
+    explicit PageView(const unsigned char *buffer) : page((const Page *) buffer) {}
+
+    const Page *get() const { return page; }
+    const Page *operator->() const { return page; }
+    const Page &operator*() const { return *page; }
+    explicit operator bool() const { return page != nullptr; }
+
+    int packetId() const {
+        /***
+         * Function for reading the current packet id, the static page has none and always returns 0
+         */
+
+        if constexpr (HasPacketId<Page>::value) {
+            return *(const volatile int *) &page->packetId;
+        } else {
+            return 0;
+        }
+    }
+
+    bool snapshot(Page &out, int attempts = 3) const {
+        /***
+         * Function for copying the page while the game may be writing it. The copy is only accepted
+         * when the packet id did not change during the copy.
+         *
+         * return: true if a consistent copy was made
+         */
+
+        for (int attempt = 0; attempt < attempts; attempt++) {
+            int before = packetId();
+            std::atomic_thread_fence(std::memory_order_acquire);
+            std::memcpy((void *) &out, (const void *) page, sizeof(Page));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (before == packetId()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    const Page *page = nullptr;
+};
+
+typedef PageView<SPageFilePhysics> PhysicsView;
+typedef PageView<SPageFileGraphic> GraphicsView;
+typedef PageView<SPageFileStatic> StaticView;
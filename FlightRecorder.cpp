@@ -0,0 +1,395 @@
+/*
+ * FlightRecorder.cpp: Capture and writer threads of the incident flight recorder.
+ *
+ * Window file layout (little endian, no padding):
+ *   FlightRecorderFileHeader
+ *   frameCount x { double time, SPageFilePhysics, SPageFileGraphic }
+*/
+
+#include "FlightRecorder.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+using namespace std;
+
+// Window buffers: one being copied out of the ring while the writer flushes the other
+static const size_t WINDOW_BUFFERS = 2;
+
+// Frames copied from the ring per poll, the copy has to outrun the one slot a new packet can overwrite per poll
+static const size_t COPY_FRAMES_PER_POLL = 64;
+
+#pragma pack(push)
+#pragma pack(4)
+
+struct FlightRecorderFileHeader {
+    char magic[8];                      // "ACCFRv1"
+    uint32_t physicsSize;
+    uint32_t graphicsSize;
+    uint32_t frameCount;
+    uint32_t triggerIndex;              // index of the frame that fired the trigger
+    int32_t reasons;                    // FR_TRIGGER_* bitmask
+    int32_t pollRateHz;
+};
+
+#pragma pack(pop)
+
+FlightRecorder::~FlightRecorder() {
+    stop();
+}
+
+void FlightRecorder::start(const FlightRecorderConfig &cfg, const ACCReader &reader) {
+    /***
+     * Function for starting the capture and writer threads
+     *
+     * cfg: recorder configuration, copied
+     * reader: reader with initialized physics and graphics pages, its mappings must stay alive until stop()
+     */
+
+    if (running) {
+        throw runtime_error("Flight recorder is already running");
+    }
+    if (cfg.pollRateHz <= 0 || cfg.maxPacketRateHz <= 0 || cfg.preTriggerSeconds < 0 || cfg.postTriggerSeconds < 0) {
+        throw invalid_argument("Flight recorder rates must be positive and trigger windows non-negative");
+    }
+
+    filesystem::create_directories(cfg.outputDir);
+
+    physics = reader.physics();
+    graphics = reader.graphics();
+    config = cfg;
+
+    // windows are cut by timestamp, the ring only has to hold the most packets a window can contain
+    size_t capacity = (size_t) ceil((config.preTriggerSeconds + config.postTriggerSeconds) * config.maxPacketRateHz) + 1;
+    ring.assign(capacity, FlightRecorderFrame());
+    ringHead = 0;
+    ringSize = 0;
+    triggerTime = 0;
+    framesSinceTrigger = 0;
+    pendingReasons = 0;
+
+    windows.assign(WINDOW_BUFFERS, Window());
+    for (Window &window : windows) {
+        window.frames.resize(capacity);
+    }
+    copyWindow = nullptr;
+
+    capturing = false;
+    manualTrigger = false;
+    frameCount = 0;
+    writtenCount = 0;
+    {
+        lock_guard<mutex> lock(writeMutex);
+        writerStop = false;
+        writeQueue.clear();
+        writeQueue.reserve(WINDOW_BUFFERS);
+        freeWindows.clear();
+        for (Window &window : windows) {
+            freeWindows.push_back(&window);
+        }
+        windowIndex = 0;
+        failedCount = 0;
+        lastErrorMessage.clear();
+    }
+    running = true;
+
+    writerThread = thread(&FlightRecorder::writerLoop, this);
+    captureThread = thread(&FlightRecorder::captureLoop, this);
+}
+
+void FlightRecorder::stop() {
+    /***
+     * Function for stopping the recorder, a window that is still capturing is flushed as is
+     */
+
+    running = false;
+    if (captureThread.joinable()) {
+        captureThread.join();
+    }
+
+    {
+        lock_guard<mutex> lock(writeMutex);
+        writerStop = true;
+    }
+    writeCondition.notify_one();
+    if (writerThread.joinable()) {
+        writerThread.join();
+    }
+}
+
+void FlightRecorder::trigger() {
+    manualTrigger = true;
+}
+
+string FlightRecorder::lastFile() {
+    lock_guard<mutex> lock(writeMutex);
+    return lastFileName;
+}
+
+string FlightRecorder::lastError() {
+    lock_guard<mutex> lock(writeMutex);
+    return lastErrorMessage;
+}
+
+uint64_t FlightRecorder::windowsFailed() {
+    lock_guard<mutex> lock(writeMutex);
+    return failedCount;
+}
+
+bool FlightRecorder::readFrame(FlightRecorderFrame &frame) {
+    /***
+     * Function for copying both pages out of shared memory
+     *
+     * return: true if a consistent copy of both pages was made
+     */
+
+    return physics.snapshot(frame.physics) && graphics.snapshot(frame.graphics);
+}
+
+int FlightRecorder::detectTriggers(const FlightRecorderFrame &frame, const FlightRecorderFrame &previous) const {
+    /***
+     * Function for checking the trigger conditions, conditions fire on their rising edge
+     * so a car sitting in the gravel does not keep triggering
+     *
+     * return: FR_TRIGGER_* bitmask
+     */
+
+    int reasons = 0;
+
+    float yawRate = fabs(frame.physics.localAngularVel[1]);
+    float previousYawRate = fabs(previous.physics.localAngularVel[1]);
+    if (yawRate > config.spinYawRate && previousYawRate <= config.spinYawRate) {
+        reasons |= FR_TRIGGER_SPIN;
+    }
+
+    if (frame.physics.numberOfTyresOut > config.tyresOutThreshold &&
+        previous.physics.numberOfTyresOut <= config.tyresOutThreshold) {
+        reasons |= FR_TRIGGER_OFF_TRACK;
+    }
+
+    for (unsigned i = 0; i < sizeof(frame.physics.carDamage) / sizeof(frame.physics.carDamage[0]); i++) {
+        if (frame.physics.carDamage[i] - previous.physics.carDamage[i] > config.damageThreshold) {
+            reasons |= FR_TRIGGER_DAMAGE;
+            break;
+        }
+    }
+
+    if ((frame.graphics.penalty != previous.graphics.penalty && frame.graphics.penalty != NONE) ||
+        frame.graphics.penaltyTime > previous.graphics.penaltyTime) {
+        reasons |= FR_TRIGGER_PENALTY;
+    }
+
+    return reasons & config.triggerMask;
+}
+
+void FlightRecorder::pushFrame(const FlightRecorderFrame &frame) {
+    ring[ringHead] = frame;
+    ringHead = (ringHead + 1) % ring.size();
+    if (ringSize < ring.size()) {
+        ringSize++;
+    }
+}
+
+void FlightRecorder::closeWindow() {
+    /***
+     * Function for handing the finished window to a free window buffer. Frames older than preTriggerSeconds
+     * before the trigger are left out. Only the first frames are copied here, the rest follows over the next
+     * polls so the capture thread never stalls on a full window copy.
+     */
+
+    capturing = false;
+
+    // a previous window still being copied has to be finished before its ring slots are reused
+    if (copyWindow) {
+        copyWindowFrames(SIZE_MAX);
+    }
+
+    Window *window = nullptr;
+    {
+        lock_guard<mutex> lock(writeMutex);
+        if (freeWindows.empty()) {
+            failedCount++;
+            lastErrorMessage = "Flight recorder window dropped, the writer is still busy with the previous windows";
+            return;
+        }
+        window = freeWindows.back();
+        freeWindows.pop_back();
+    }
+
+    size_t oldest = (ringHead + ring.size() - ringSize) % ring.size();
+    size_t skip = 0;
+    while (skip < ringSize && ring[(oldest + skip) % ring.size()].time < triggerTime - config.preTriggerSeconds) {
+        skip++;
+    }
+
+    window->reasons = pendingReasons;
+    window->frameCount = ringSize - skip;
+    // the trigger frame was pushed out if packets arrived faster than maxPacketRateHz
+    window->triggerIndex = framesSinceTrigger < window->frameCount ? window->frameCount - 1 - framesSinceTrigger : 0;
+
+    copyWindow = window;
+    copySource = (oldest + skip) % ring.size();
+    copiedFrames = 0;
+
+    // the next packet overwrites the oldest ring slot, which may be the first frame of this window
+    copyWindowFrames(COPY_FRAMES_PER_POLL);
+}
+
+void FlightRecorder::copyWindowFrames(size_t maxFrames) {
+    /***
+     * Function for copying the next frames of copyWindow out of the ring, the window is queued
+     * for the writer once it is complete
+     */
+
+    size_t count = min(maxFrames, copyWindow->frameCount - copiedFrames);
+    for (size_t i = 0; i < count; i++) {
+        copyWindow->frames[copiedFrames++] = ring[copySource];
+        copySource = (copySource + 1) % ring.size();
+    }
+
+    if (copiedFrames == copyWindow->frameCount) {
+        {
+            lock_guard<mutex> lock(writeMutex);
+            writeQueue.push_back(copyWindow);
+        }
+        writeCondition.notify_one();
+        copyWindow = nullptr;
+    }
+}
+
+void FlightRecorder::captureLoop() {
+    /***
+     * Function for polling shared memory faster than the game writes it so every physics packet is seen.
+     * Only new physics packets are stored, a paused game therefore does not push the pre trigger frames
+     * out of the buffer. Windows are cut by packet timestamp.
+     */
+
+    using clock = chrono::steady_clock;
+    auto period = chrono::duration_cast<clock::duration>(chrono::duration<double>(1.0 / config.pollRateHz));
+    auto startTime = clock::now();
+    auto next = startTime;
+
+    FlightRecorderFrame frame;
+    FlightRecorderFrame previous;
+    bool havePrevious = false;
+
+    while (running) {
+        next += period;
+
+        if (copyWindow) {
+            copyWindowFrames(COPY_FRAMES_PER_POLL);
+        }
+
+        if (readFrame(frame) && (!havePrevious || frame.physics.packetId != previous.physics.packetId)) {
+            frame.time = chrono::duration<double>(clock::now() - startTime).count();
+
+            int reasons = havePrevious ? detectTriggers(frame, previous) : 0;
+            if (manualTrigger.exchange(false)) {
+                reasons |= FR_TRIGGER_MANUAL & config.triggerMask;
+            }
+
+            pushFrame(frame);
+            previous = frame;
+            havePrevious = true;
+            frameCount++;
+
+            if (capturing) {
+                // triggers during the post trigger window are folded into the running window
+                pendingReasons |= reasons;
+                framesSinceTrigger++;
+            } else if (reasons) {
+                capturing = true;
+                pendingReasons = reasons;
+                triggerTime = frame.time;
+                framesSinceTrigger = 0;
+            }
+
+            if (capturing && frame.time - triggerTime >= config.postTriggerSeconds) {
+                closeWindow();
+            }
+        }
+
+        this_thread::sleep_until(next);
+    }
+
+    if (capturing) {
+        closeWindow();
+    }
+    if (copyWindow) {
+        copyWindowFrames(SIZE_MAX);
+    }
+}
+
+void FlightRecorder::writerLoop() {
+    /***
+     * Function for flushing completed windows to disk outside of the capture thread
+     */
+
+    unique_lock<mutex> lock(writeMutex);
+    while (true) {
+        writeCondition.wait(lock, [this] { return writerStop || !writeQueue.empty(); });
+        if (writeQueue.empty()) {
+            break;
+        }
+
+        Window *window = writeQueue.front();
+        writeQueue.erase(writeQueue.begin());
+        string fileName = "acc_incident_" + to_string((long long) time(nullptr)) + "_" + to_string(windowIndex++) + ".bin";
+        string path = (filesystem::path(config.outputDir) / fileName).string();
+
+        lock.unlock();
+        string error = writeWindow(*window, path);
+        lock.lock();
+
+        // failures are reported through getFlightRecorderStatus(), there is no caller to throw to
+        if (error.empty()) {
+            lastFileName = path;
+            writtenCount++;
+        } else {
+            failedCount++;
+            lastErrorMessage = error;
+        }
+        freeWindows.push_back(window);
+    }
+}
+
+string FlightRecorder::writeWindow(const Window &window, const string &path) {
+    /***
+     * Function for writing one window to disk
+     *
+     * return: empty string on success, error message otherwise
+     */
+
+    FlightRecorderFileHeader header = {};
+    memcpy(header.magic, "ACCFRv1", 8);
+    header.physicsSize = sizeof(SPageFilePhysics);
+    header.graphicsSize = sizeof(SPageFileGraphic);
+    header.frameCount = (uint32_t) window.frameCount;
+    header.triggerIndex = (uint32_t) window.triggerIndex;
+    header.reasons = window.reasons;
+    header.pollRateHz = config.pollRateHz;
+
+    ofstream out(path, ios::binary);
+    if (!out) {
+        return "Opening flight recorder window " + path + " failed";
+    }
+    out.write((const char *) &header, sizeof(header));
+    for (size_t i = 0; i < window.frameCount; i++) {
+        const FlightRecorderFrame &frame = window.frames[i];
+        out.write((const char *) &frame.time, sizeof(frame.time));
+        out.write((const char *) &frame.physics, sizeof(frame.physics));
+        out.write((const char *) &frame.graphics, sizeof(frame.graphics));
+    }
+    out.close();
+
+    if (!out) {
+        return "Writing flight recorder window " + path + " failed";
+    }
+
+    return "";
+}
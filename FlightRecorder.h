@@ -0,0 +1,120 @@
+/*
+ * FlightRecorder.h: Trigger based recorder that keeps the last seconds of raw physics/graphics frames in memory
+ *                   and writes the window around an incident (spin, off track, damage, penalty) to disk.
+*/
+
+#pragma once
+
+#include "ACCReader.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Trigger reasons, combined as bitmask in a recorded window
+#define FR_TRIGGER_MANUAL 1
+#define FR_TRIGGER_SPIN 2
+#define FR_TRIGGER_OFF_TRACK 4
+#define FR_TRIGGER_DAMAGE 8
+#define FR_TRIGGER_PENALTY 16
+
+struct FlightRecorderConfig {
+    std::string outputDir = ".";
+    double preTriggerSeconds = 10.0;
+    double postTriggerSeconds = 5.0;
+    int pollRateHz = 1000;              // must be above the packet rate, ACC physics runs at ~333Hz
+    int maxPacketRateHz = 500;          // upper bound on the packet rate, sizes the ring buffer
+
+    int triggerMask = FR_TRIGGER_MANUAL | FR_TRIGGER_SPIN | FR_TRIGGER_OFF_TRACK | FR_TRIGGER_DAMAGE | FR_TRIGGER_PENALTY;
+    float spinYawRate = 2.5f;           // rad/s around the vertical axis (localAngularVel[1])
+    int tyresOutThreshold = 2;          // trigger when more than this many tyres are out
+    float damageThreshold = 0.0f;       // trigger when any carDamage value increases by more than this
+};
+
+struct FlightRecorderFrame {
+    double time;                        // seconds since recorder start
+    SPageFilePhysics physics;
+    SPageFileGraphic graphics;
+};
+
+class FlightRecorder {
+public:
+    FlightRecorder() = default;
+    ~FlightRecorder();
+
+    FlightRecorder(const FlightRecorder &) = delete;
+    FlightRecorder &operator=(const FlightRecorder &) = delete;
+
+    // throws MappingError when the physics or graphics page is not initialized
+    void start(const FlightRecorderConfig &config, const ACCReader &reader);
+    void stop();
+    void trigger();
+
+    bool isRunning() const { return running; }
+    bool isCapturing() const { return capturing; }
+    uint64_t framesRecorded() const { return frameCount; }
+    uint64_t windowsWritten() const { return writtenCount; }
+    uint64_t windowsFailed();
+    std::string lastFile();
+    std::string lastError();
+
+private:
+    struct Window {
+        int reasons = 0;
+        size_t triggerIndex = 0;
+        size_t frameCount = 0;
+        std::vector<FlightRecorderFrame> frames;    // allocated in start(), never on the capture thread
+    };
+
+    void captureLoop();
+    void writerLoop();
+    bool readFrame(FlightRecorderFrame &frame);
+    int detectTriggers(const FlightRecorderFrame &frame, const FlightRecorderFrame &previous) const;
+    void pushFrame(const FlightRecorderFrame &frame);
+    void closeWindow();
+    void copyWindowFrames(size_t maxFrames);
+    std::string writeWindow(const Window &window, const std::string &path);
+
+    FlightRecorderConfig config;
+    PhysicsView physics;
+    GraphicsView graphics;
+
+    // Ring buffer holding pre + post trigger frames, only touched by the capture thread
+    std::vector<FlightRecorderFrame> ring;
+    size_t ringHead = 0;
+    size_t ringSize = 0;
+    double triggerTime = 0;
+    size_t framesSinceTrigger = 0;
+    int pendingReasons = 0;
+
+    // Window being copied out of the ring a few frames per poll, only touched by the capture thread
+    Window *copyWindow = nullptr;
+    size_t copySource = 0;
+    size_t copiedFrames = 0;
+
+    // Window buffers, handed between the capture and writer thread under writeMutex
+    std::vector<Window> windows;
+
+    std::atomic<bool> running{false};
+    std::atomic<bool> capturing{false};
+    std::atomic<bool> manualTrigger{false};
+    std::atomic<uint64_t> frameCount{0};
+    std::atomic<uint64_t> writtenCount{0};
+
+    std::thread captureThread;
+    std::thread writerThread;
+
+    // Completed windows waiting to be flushed by the writer thread
+    std::mutex writeMutex;
+    std::condition_variable writeCondition;
+    std::vector<Window *> freeWindows;
+    std::vector<Window *> writeQueue;
+    bool writerStop = false;
+    uint64_t windowIndex = 0;
+    uint64_t failedCount = 0;
+    std::string lastFileName;
+    std::string lastErrorMessage;
+};
@@ -0,0 +1,161 @@
+/*
+ * MappingBackend.cpp: Win32 and POSIX implementations of the shared memory mapping backends.
+*/
+
+#include "MappingBackend.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+static void touchPages(const unsigned char *buffer, size_t size, size_t pageSize) {
+    /***
+     * Function for reading one byte of every page so the pages are faulted in before the first real read
+     */
+
+    volatile unsigned char sink = 0;
+    for (size_t offset = 0; offset < size; offset += pageSize) {
+        sink = sink + buffer[offset];
+    }
+    sink = sink + buffer[size - 1];
+}
+
+#ifdef _WIN32
+
+void Win32MappingBackend::open(const string &name, size_t size, bool prefault) {
+    close();
+
+    string mapName = "Local\\" + name;
+    hMapFile = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, (DWORD) size, mapName.c_str());
+    if (!hMapFile) {
+        throw MappingError("Creating filemap " + mapName + " failed (error " + to_string(GetLastError()) + ")");
+    }
+
+    buffer = (const unsigned char *) MapViewOfFile(hMapFile, FILE_MAP_READ, 0, 0, size);
+    if (!buffer) {
+        DWORD error = GetLastError();
+        close();
+        throw MappingError("Mapping view of " + mapName + " failed (error " + to_string(error) + ")");
+    }
+    length = size;
+
+    if (prefault) {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        touchPages(buffer, length, info.dwPageSize);
+
+        if (!VirtualLock((LPVOID) buffer, length)) {
+            DWORD error = GetLastError();
+            close();
+            throw MappingError("Locking pages of " + mapName + " failed (error " + to_string(error) + ")");
+        }
+        locked = true;
+    }
+}
+
+void Win32MappingBackend::close() {
+    if (buffer) {
+        if (locked) {
+            VirtualUnlock((LPVOID) buffer, length);
+        }
+        UnmapViewOfFile(buffer);
+    }
+    if (hMapFile) {
+        CloseHandle(hMapFile);
+    }
+    hMapFile = nullptr;
+    buffer = nullptr;
+    length = 0;
+    locked = false;
+}
+
+#else
+
+void PosixMappingBackend::open(const string &name, size_t size, bool prefault) {
+    close();
+
+    // The pages belong to the writer (bridge or test rig), they are only opened read-only and never created or resized
+    string shmName = "/" + name;
+    int fd = shm_open(shmName.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        if (errno == ENOENT) {
+            throw MappingError("Shared memory " + shmName + " does not exist, is the game or bridge running?");
+        }
+        throw MappingError("Opening shared memory " + shmName + " failed: " + strerror(errno));
+    }
+
+    // mapping past the end of the object would SIGBUS on the first read
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        int error = errno;
+        ::close(fd);
+        throw MappingError("Reading size of shared memory " + shmName + " failed: " + strerror(error));
+    }
+    if ((size_t) st.st_size < size) {
+        ::close(fd);
+        throw MappingError("Shared memory " + shmName + " is smaller than " + to_string(size) + " bytes");
+    }
+
+    int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    if (prefault) {
+        flags |= MAP_POPULATE;
+    }
+#endif
+
+    void *mapped = mmap(nullptr, size, PROT_READ, flags, fd, 0);
+    int error = errno;
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        throw MappingError("Mapping shared memory " + shmName + " failed: " + strerror(error));
+    }
+    buffer = (const unsigned char *) mapped;
+    length = size;
+
+    if (prefault) {
+        touchPages(buffer, length, (size_t) sysconf(_SC_PAGESIZE));
+
+        if (mlock(buffer, length) != 0) {
+            error = errno;
+            close();
+            throw MappingError("Locking pages of " + shmName + " failed: " + strerror(error));
+        }
+        locked = true;
+    }
+}
+
+void PosixMappingBackend::close() {
+    if (buffer) {
+        if (locked) {
+            munlock(buffer, length);
+        }
+        munmap((void *) buffer, length);
+    }
+    buffer = nullptr;
+    length = 0;
+    locked = false;
+}
+
+#endif
+
+unique_ptr<MappingBackend> createMappingBackend(const string &kind) {
+#ifdef _WIN32
+    if (kind == "default" || kind == "win32") {
+        return make_unique<Win32MappingBackend>();
+    }
+#else
+    if (kind == "default" || kind == "posix") {
+        return make_unique<PosixMappingBackend>();
+    }
+#endif
+    throw MappingError("Mapping backend '" + kind + "' is not available on this platform");
+}
@@ -0,0 +1,71 @@
+/*
+ * MappingBackend.h: Backends for mapping the ACC shared memory pages into this process.
+ *                   Win32 uses named file mappings, POSIX uses shm_open/mmap (Linux test rigs, Proton/Wine bridges).
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+class MappingError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+class MappingBackend {
+public:
+    virtual ~MappingBackend() = default;
+
+    /***
+     * Win32 creates the page when it does not exist yet, POSIX only opens a page the writer created.
+     *
+     * name: page name without platform prefix, e.g. "acpmf_physics"
+     * size: number of bytes to map
+     * prefault: fault in and lock all pages up front so the first reads do not page fault
+     *
+     * throws MappingError on failure, the backend is left closed
+     */
+    virtual void open(const std::string &name, size_t size, bool prefault) = 0;
+    virtual void close() = 0;
+
+    const unsigned char *data() const { return buffer; }
+    size_t size() const { return length; }
+    bool isOpen() const { return buffer != nullptr; }
+    bool isLocked() const { return locked; }
+
+protected:
+    const unsigned char *buffer = nullptr;
+    size_t length = 0;
+    bool locked = false;
+};
+
+#ifdef _WIN32
+
+class Win32MappingBackend : public MappingBackend {
+public:
+    ~Win32MappingBackend() override { close(); }
+
+    void open(const std::string &name, size_t size, bool prefault) override;
+    void close() override;
+
+private:
+    void *hMapFile = nullptr;
+};
+
+#else
+
+class PosixMappingBackend : public MappingBackend {
+public:
+    ~PosixMappingBackend() override { close(); }
+
+    void open(const std::string &name, size_t size, bool prefault) override;
+    void close() override;
+};
+
+#endif
+
+// kind: "win32", "posix" or "default" for the native backend of this platform
+std::unique_ptr<MappingBackend> createMappingBackend(const std::string &kind);
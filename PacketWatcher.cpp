@@ -0,0 +1,97 @@
+/*
+ * PacketWatcher.cpp: Polling thread of the packet watcher.
+*/
+
+#include "PacketWatcher.h"
+#include <stdexcept>
+
+using namespace std;
+
+PacketWatcher::~PacketWatcher() {
+    stop();
+}
+
+void PacketWatcher::onPhysics(PhysicsCallback callback) {
+    if (running) {
+        throw runtime_error("Packet watcher callbacks can only be changed while stopped");
+    }
+    physicsCallback = move(callback);
+}
+
+void PacketWatcher::onGraphics(GraphicsCallback callback) {
+    if (running) {
+        throw runtime_error("Packet watcher callbacks can only be changed while stopped");
+    }
+    graphicsCallback = move(callback);
+}
+
+void PacketWatcher::start(const ACCReader &reader, chrono::microseconds pollInterval) {
+    /***
+     * Function for starting the watcher thread, the reader mappings must stay alive until stop()
+     */
+
+    if (running) {
+        throw runtime_error("Packet watcher is already running");
+    }
+    // a watcher stopped by a failing callback still has its thread to join
+    stop();
+    {
+        lock_guard<mutex> lock(errorMutex);
+        lastErrorMessage.clear();
+    }
+
+    physics = physicsCallback ? reader.physics() : PhysicsView();
+    graphics = graphicsCallback ? reader.graphics() : GraphicsView();
+
+    running = true;
+    watchThread = thread(&PacketWatcher::watchLoop, this, pollInterval);
+}
+
+void PacketWatcher::stop() {
+    running = false;
+    if (watchThread.joinable()) {
+        watchThread.join();
+    }
+}
+
+string PacketWatcher::lastError() {
+    lock_guard<mutex> lock(errorMutex);
+    return lastErrorMessage;
+}
+
+void PacketWatcher::watchLoop(chrono::microseconds pollInterval) {
+    try {
+        pollPackets(pollInterval);
+    } catch (const exception &e) {
+        lock_guard<mutex> lock(errorMutex);
+        lastErrorMessage = e.what();
+    } catch (...) {
+        lock_guard<mutex> lock(errorMutex);
+        lastErrorMessage = "Unknown exception in packet callback";
+    }
+    running = false;
+}
+
+void PacketWatcher::pollPackets(chrono::microseconds pollInterval) {
+    SPageFilePhysics physicsPacket;
+    SPageFileGraphic graphicsPacket;
+    int lastPhysicsId = physics ? physics.packetId() : 0;
+    int lastGraphicsId = graphics ? graphics.packetId() : 0;
+
+    auto next = chrono::steady_clock::now();
+    while (running) {
+        next += pollInterval;
+
+        if (physics && physics.packetId() != lastPhysicsId && physics.snapshot(physicsPacket)) {
+            lastPhysicsId = physicsPacket.packetId;
+            physicsCallback(physicsPacket);
+        }
+
+        if (graphics && graphics.packetId() != lastGraphicsId && graphics.snapshot(graphicsPacket)) {
+            lastGraphicsId = graphicsPacket.packetId;
+            graphicsCallback(graphicsPacket);
+        }
+
+        this_thread::sleep_until(next);
+    }
+}
@@ -0,0 +1,53 @@
+/*
+ * PacketWatcher.h: Polls the physics and graphics pages on a native thread and calls back on every new packet.
+*/
+
+#pragma once
+
+#include "ACCReader.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class PacketWatcher {
+public:
+    // Callbacks run on the watcher thread and receive a consistent copy of the page.
+    // An exception thrown by a callback stops the watcher, the message is kept in lastError()
+    typedef std::function<void(const SPageFilePhysics &)> PhysicsCallback;
+    typedef std::function<void(const SPageFileGraphic &)> GraphicsCallback;
+
+    PacketWatcher() = default;
+    ~PacketWatcher();
+
+    PacketWatcher(const PacketWatcher &) = delete;
+    PacketWatcher &operator=(const PacketWatcher &) = delete;
+
+    // set before start()
+    void onPhysics(PhysicsCallback callback);
+    void onGraphics(GraphicsCallback callback);
+
+    // throws MappingError when a page with a callback is not initialized
+    void start(const ACCReader &reader, std::chrono::microseconds pollInterval = std::chrono::microseconds(1000));
+    void stop();
+
+    bool isRunning() const { return running; }
+    std::string lastError();
+
+private:
+    void watchLoop(std::chrono::microseconds pollInterval);
+    void pollPackets(std::chrono::microseconds pollInterval);
+
+    PhysicsCallback physicsCallback;
+    GraphicsCallback graphicsCallback;
+    PhysicsView physics;
+    GraphicsView graphics;
+
+    std::atomic<bool> running{false};
+    std::thread watchThread;
+
+    std::mutex errorMutex;
+    std::string lastErrorMessage;
+};
@@ -1,15 +1,17 @@
 /*
- * SM.cpp: Main file for reading Assetto Corsa Competizione shared memory and formatting data for pybind11.
- *         Pybind11 is used to convert c++ code to python module.
+ * SM.cpp: Python module on top of the native reading core (ACCReader.h), formats Assetto Corsa Competizione
+ *         shared memory data for pybind11. Pybind11 is used to convert c++ code to python module.
  *
  * ACC shared memory docs: https://www.assettocorsa.net/forum/index.php?threads/acc-shared-memory-documentation.59965/
 */
 
 #include "pybind11/pybind11.h"
+#ifdef _WIN32
 #include "stdafx.h"
+#endif
 #include "SharedFileOut.h"
-#include <windows.h>
-#include <tchar.h>
+#include "FlightRecorder.h"
+#include "ACCReader.h"
 #include <string>
 #include <map>
 #include <any>
@@ -25,71 +27,48 @@ inline unsigned arraysize(const T(&v)[S]) {
     return S;
 }
 
-struct SMElement {
-    HANDLE hMapFile;
-    unsigned char *mapFileBuffer;
+ACCReader m_reader;
+FlightRecorder m_recorder;
 
-};
+void requireRecorderStopped() {
+    // the recorder reads the mapped pages directly, they must not be remapped underneath it
+    if (m_recorder.isRunning()) {
+        throw MappingError("Stop the flight recorder before re-initializing shared memory");
+    }
+}
 
-SMElement m_physics;
-SMElement m_graphics;
-SMElement m_static;
+void setMappingBackend(const std::string &kind) {
+    /***
+     * Function for selecting the mapping backend used by the next init call ("default", "win32" or "posix")
+     */
 
-void initPhysics() {
+    m_reader.setBackend(kind);
+}
+
+void initPhysics(bool prefault) {
     /***
     * Function for initializing retrieving in-game physics data from shared memory
     */
 
-    TCHAR szName[] = TEXT("Local\\acpmf_physics");
-    m_physics.hMapFile = CreateFileMapping(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, sizeof(SPageFilePhysics),szName);
-    if (!m_physics.hMapFile)
-    {
-        std::cout << "Creating filemap for storing physics data failed" << endl;
-    }
-
-    m_physics.mapFileBuffer = (unsigned char *) MapViewOfFile(m_physics.hMapFile, FILE_MAP_READ, 0, 0,sizeof(SPageFilePhysics));
-    if (!m_physics.mapFileBuffer)
-    {
-        std::cout << "Retrieving physics data from shared memory access failed" << endl;
-    }
+    requireRecorderStopped();
+    m_reader.initPhysics(prefault);
 }
 
-void initGraphics() {
+void initGraphics(bool prefault) {
     /***
     * Function for initializing retrieving in-game graphics data from shared memory
     */
 
-    TCHAR szName[] = TEXT("Local\\acpmf_graphics");
-    m_graphics.hMapFile = CreateFileMapping(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, sizeof(SPageFileGraphic),szName);
-    if (!m_graphics.hMapFile)
-    {
-        std::cout << "Creating filemap for storing graphics data failed" << endl;
-    }
-
-    m_graphics.mapFileBuffer = (unsigned char *) MapViewOfFile(m_graphics.hMapFile, FILE_MAP_READ, 0, 0,sizeof(SPageFileGraphic));
-    if (!m_graphics.mapFileBuffer)
-    {
-        std::cout << "Retrieving graphics data from shared memory access failed" << endl;
-    }
+    requireRecorderStopped();
+    m_reader.initGraphics(prefault);
 }
 
-void initStatic() {
+void initStatic(bool prefault) {
     /***
      * Function for initializing retrieving in-game static data from shared memory
      */
 
-    TCHAR szName[] = TEXT("Local\\acpmf_static");
-    m_static.hMapFile = CreateFileMapping(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, sizeof(SPageFileStatic),szName);
-    if (!m_static.hMapFile)
-    {
-        std::cout << "Creating filemap for storing static data failed" << endl;
-    }
-
-    m_static.mapFileBuffer = (unsigned char *) MapViewOfFile(m_static.hMapFile, FILE_MAP_READ, 0, 0,sizeof(SPageFileStatic));
-    if (!m_static.mapFileBuffer)
-    {
-        std::cout << "Retrieving static data from shared memory access failed" << endl;
-    }
+    m_reader.initStatic(prefault);
 }
 
 py::dict getPhysicsData() {
@@ -101,7 +80,7 @@ py::dict getPhysicsData() {
      */
 
     //Fill struct with physics data from buffer
-    SPageFilePhysics *pfPhysics = (SPageFilePhysics *) m_physics.mapFileBuffer;
+    const SPageFilePhysics *pfPhysics = m_reader.physics().get();
 
     //Fill python dictionary with telemetry data from physics struct
     py::dict physicsDict;
@@ -180,7 +159,7 @@ py::dict getGraphicsData() {
     */
 
     //Fill struct with graphics data from buffer
-    SPageFileGraphic *pfGraphics = (SPageFileGraphic *) m_graphics.mapFileBuffer;
+    const SPageFileGraphic *pfGraphics = m_reader.graphics().get();
 
     //Fill python dictionairy with telemetry data from physics struct
     py::dict graphicsDict;
@@ -281,7 +260,7 @@ py::dict getStaticData() {
     */
 
     //Fill struct with graphics data from buffer
-    SPageFileStatic *pfStatic = (SPageFileStatic *) m_static.mapFileBuffer;
+    const SPageFileStatic *pfStatic = m_reader.staticData().get();
 
     //Fill python dictionary with telemetry data from physics struct
     py::dict staticDict;
@@ -314,17 +293,97 @@ py::dict getStaticData() {
     return staticDict;
 }
 
+void startFlightRecorder(const std::string &outputDir, double preTriggerSeconds, double postTriggerSeconds,
+                         int pollRateHz, int maxPacketRateHz, int triggers, float spinYawRate, int tyresOutThreshold,
+                         float damageThreshold) {
+    /***
+     * Function for starting the incident flight recorder on the physics and graphics shared memory.
+     * Frames are sampled on a native thread, a window of pre + post trigger frames is written to
+     * outputDir every time one of the enabled triggers fires.
+     */
+
+    FlightRecorderConfig config;
+    config.outputDir = outputDir;
+    config.preTriggerSeconds = preTriggerSeconds;
+    config.postTriggerSeconds = postTriggerSeconds;
+    config.pollRateHz = pollRateHz;
+    config.maxPacketRateHz = maxPacketRateHz;
+    config.triggerMask = triggers;
+    config.spinYawRate = spinYawRate;
+    config.tyresOutThreshold = tyresOutThreshold;
+    config.damageThreshold = damageThreshold;
+
+    m_recorder.start(config, m_reader);
+}
+
+void stopFlightRecorder() {
+    m_recorder.stop();
+}
+
+void triggerFlightRecorder() {
+    m_recorder.trigger();
+}
+
+py::dict getFlightRecorderStatus() {
+    /***
+     * Function for retrieving the state of the flight recorder
+     *
+     * return: pybind dictionary (c++ map for python)
+     */
+
+    py::dict statusDict;
+    statusDict[py::str("running")] = m_recorder.isRunning();
+    statusDict[py::str("capturing")] = m_recorder.isCapturing();
+    statusDict[py::str("framesRecorded")] = m_recorder.framesRecorded();
+    statusDict[py::str("windowsWritten")] = m_recorder.windowsWritten();
+    statusDict[py::str("windowsFailed")] = m_recorder.windowsFailed();
+    statusDict[py::str("lastFile")] = m_recorder.lastFile();
+    statusDict[py::str("lastError")] = m_recorder.lastError();
+
+    return statusDict;
+}
+
 PYBIND11_MAKE_OPAQUE(std::map<std::string, std::any>);
 PYBIND11_MODULE(ACCSharedMemory, m) {
     m.doc() = "C++ ACCSharedMemory telemetry module";
 
-    m.def("initPhysics", &initPhysics, "Function for initializing physics telemetry");
-    m.def("initGraphics", &initGraphics, "Function for initializing Graphics telemetry");
-    m.def("initStatic", &initStatic, "Function for initializing Static telemetry");
+    py::register_exception<MappingError>(m, "MappingError", PyExc_RuntimeError);
+
+    m.def("setMappingBackend", &setMappingBackend, "Function for selecting the shared memory backend (default, win32, posix)",
+          py::arg("kind"));
+
+    m.def("initPhysics", &initPhysics, "Function for initializing physics telemetry", py::arg("prefault") = false);
+    m.def("initGraphics", &initGraphics, "Function for initializing Graphics telemetry", py::arg("prefault") = false);
+    m.def("initStatic", &initStatic, "Function for initializing Static telemetry", py::arg("prefault") = false);
+
+    m.def("isPhysicsReady", [] { return m_reader.isPhysicsReady(); }, "Function for checking if physics telemetry can be read");
+    m.def("isGraphicsReady", [] { return m_reader.isGraphicsReady(); }, "Function for checking if Graphics telemetry can be read");
+    m.def("isStaticReady", [] { return m_reader.isStaticReady(); }, "Function for checking if Static telemetry can be read");
 
     m.def("getPhysicsData", &getPhysicsData, "Function for retrieving physics telemetry data");
     m.def("getGraphicsData", &getGraphicsData, "Function for retrieving Graphics telemetry data");
     m.def("getStaticData", &getStaticData, "Function for retrieving Static telemetry data");
 
+    m.attr("TRIGGER_MANUAL") = FR_TRIGGER_MANUAL;
+    m.attr("TRIGGER_SPIN") = FR_TRIGGER_SPIN;
+    m.attr("TRIGGER_OFF_TRACK") = FR_TRIGGER_OFF_TRACK;
+    m.attr("TRIGGER_DAMAGE") = FR_TRIGGER_DAMAGE;
+    m.attr("TRIGGER_PENALTY") = FR_TRIGGER_PENALTY;
+    m.attr("TRIGGER_ALL") = FR_TRIGGER_MANUAL | FR_TRIGGER_SPIN | FR_TRIGGER_OFF_TRACK | FR_TRIGGER_DAMAGE | FR_TRIGGER_PENALTY;
+
+    m.def("startFlightRecorder", &startFlightRecorder, "Function for starting the incident flight recorder",
+          py::arg("outputDir") = ".", py::arg("preTriggerSeconds") = 10.0, py::arg("postTriggerSeconds") = 5.0,
+          py::arg("pollRateHz") = 1000, py::arg("maxPacketRateHz") = 500,
+          py::arg("triggers") = FR_TRIGGER_MANUAL | FR_TRIGGER_SPIN | FR_TRIGGER_OFF_TRACK | FR_TRIGGER_DAMAGE | FR_TRIGGER_PENALTY,
+          py::arg("spinYawRate") = 2.5f, py::arg("tyresOutThreshold") = 2, py::arg("damageThreshold") = 0.0f);
+    m.def("stopFlightRecorder", &stopFlightRecorder, "Function for stopping the flight recorder and flushing pending windows",
+          py::call_guard<py::gil_scoped_release>());
+    m.def("triggerFlightRecorder", &triggerFlightRecorder, "Function for manually triggering the flight recorder");
+    m.def("getFlightRecorderStatus", &getFlightRecorderStatus, "Function for retrieving flight recorder status");
+
+    // Join the recorder threads before the interpreter finalizes, joining them from the static destructor
+    // at process exit runs under the loader lock on Windows and can hang
+    py::module_::import("atexit").attr("register")(py::cpp_function(&stopFlightRecorder));
+
 
 }
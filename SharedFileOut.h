@@ -86,6 +86,13 @@ typedef int AC_FLAG_TYPE;
 #define AC_PENALTY_FLAG 6
 
 
+// ACC writes UTF-16 strings, wchar_t is only 16 bit on Windows
+#ifdef _WIN32
+typedef wchar_t ACC_WCHAR;
+#else
+typedef char16_t ACC_WCHAR;
+#endif
+
 #pragma pack(push)
 #pragma pack(4)
 
@@ -198,10 +205,10 @@ struct SPageFileGraphic
     int packetId = 0;
     AC_STATUS status = AC_OFF;
     AC_SESSION_TYPE session = AC_PRACTICE;
-    wchar_t currentTime[15];
-    wchar_t lastTime[15];
-    wchar_t bestTime[15];
-    wchar_t split[15];
+    ACC_WCHAR currentTime[15];
+    ACC_WCHAR lastTime[15];
+    ACC_WCHAR bestTime[15];
+    ACC_WCHAR split[15];
     int completedLaps = 0;
     int position = 0;
     int iCurrentTime = 0;
@@ -213,7 +220,7 @@ struct SPageFileGraphic
     int currentSectorIndex = 0;
     int lastSectorTime = 0;
     int numberOfLaps = 0;
-    wchar_t tyreCompound[33];
+    ACC_WCHAR tyreCompound[33];
 
     //float replayTimeMultiplier = 0;
 
@@ -252,15 +259,15 @@ struct SPageFileGraphic
     int rainTyres = 0;
     int sessionIndex = 0;
     float usedFuel = 0;
-    wchar_t deltaLapTime[15];
+    ACC_WCHAR deltaLapTime[15];
     int iDeltaLapTime = 0;
-    wchar_t estimatedLapTime [15];
+    ACC_WCHAR estimatedLapTime [15];
     int iEstimatedLapTime = 0;
     int isDeltaPositive = 0;
     int iSplit = 0;
     int isValidLap = 0;
     float fuelEstimatedLaps = 0;
-    wchar_t trackStatus[33];
+    ACC_WCHAR trackStatus[33];
     int missingMandatoryPits = 0;
     float Clock = 0;
     int directionLightsLeft = 0;
@@ -296,17 +303,17 @@ struct SPageFileGraphic
 
 struct SPageFileStatic
 {
-    wchar_t smVersion[15];
-    wchar_t acVersion[15];
+    ACC_WCHAR smVersion[15];
+    ACC_WCHAR acVersion[15];
 
     // session static info
     int numberOfSessions = 0;
     int numCars = 0;
-    wchar_t carModel[33];
-    wchar_t track[33];
-    wchar_t playerName[33];
-    wchar_t playerSurname[33];
-    wchar_t playerNick[33];
+    ACC_WCHAR carModel[33];
+    ACC_WCHAR track[33];
+    ACC_WCHAR playerName[33];
+    ACC_WCHAR playerSurname[33];
+    ACC_WCHAR playerNick[33];
     int sectorCount = 0;
 
     // car static info
@@ -338,18 +345,18 @@ struct SPageFileStatic
 //    int engineBrakeSettingsCount = 0;
 //    int ersPowerControllerCount = 0;
 //    float trackSPlineLength = 0;
-//    wchar_t trackConfiguration[33];
+//    ACC_WCHAR trackConfiguration[33];
 //    float ersMaxJ = 0;
 //    int isTimedRace = 0;
 //    int hasExtraLap = 0;
-//    wchar_t carSkin[33];
+//    ACC_WCHAR carSkin[33];
 //    int reversedGridPositions = 0;
 
     int PitWindowStart = 0;
     int PitWindowEnd = 0;
     int isOnline = 0;
-    wchar_t dryTyresName[33];
-    wchar_t wetTyresName[33];
+    ACC_WCHAR dryTyresName[33];
+    ACC_WCHAR wetTyresName[33];
 };
 
 
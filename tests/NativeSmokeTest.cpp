@@ -0,0 +1,304 @@
+/*
+ * NativeSmokeTest.cpp: Smoke test of the native core. Writes fake pages to /dev/shm like a bridge would and
+ *                      reads them back through the C API, ACCReader and the flight recorder (POSIX backend).
+*/
+
+#include "ACCReader.h"
+#include "ACCSharedMemoryC.h"
+#include "FlightRecorder.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <sys/mman.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            cout << __FILE__ << ":" << __LINE__ << ": check failed: " #condition << endl; \
+            failures++; \
+        } \
+    } while (0)
+
+// exit code ctest reports as skipped
+static const int SKIPPED = 77;
+
+struct FakePage {
+    string name;
+    size_t size;
+    unsigned char *data = nullptr;
+
+    FakePage(const string &pageName, size_t pageSize) : name("/" + pageName), size(pageSize) {
+        int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0) {
+            return;
+        }
+        if (ftruncate(fd, (off_t) size) == 0) {
+            void *mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            data = mapped == MAP_FAILED ? nullptr : (unsigned char *) mapped;
+        }
+        close(fd);
+    }
+
+    ~FakePage() {
+        if (data) {
+            munmap(data, size);
+            shm_unlink(name.c_str());
+        }
+    }
+};
+
+static void sleepMs(int ms) {
+    this_thread::sleep_for(chrono::milliseconds(ms));
+}
+
+static void testReadBeforeInit() {
+    ACCReader reader("posix");
+
+    bool thrown = false;
+    try {
+        reader.physics();
+    } catch (const MappingError &) {
+        thrown = true;
+    }
+    CHECK(thrown);
+    CHECK(!reader.isPhysicsReady());
+
+    thrown = false;
+    try {
+        FlightRecorder recorder;
+        recorder.start(FlightRecorderConfig(), reader);
+    } catch (const MappingError &) {
+        thrown = true;
+    }
+    CHECK(thrown);
+
+    // the pages do not exist yet and the reader must not create them
+    thrown = false;
+    try {
+        reader.initPhysics();
+    } catch (const MappingError &) {
+        thrown = true;
+    }
+    CHECK(thrown);
+    CHECK(access("/dev/shm/acpmf_physics", F_OK) != 0);
+}
+
+static atomic<int> physicsCallbacks{0};
+
+static void countPacket(int page, const void *data, size_t size, void *user) {
+    (void) data;
+    (void) user;
+    if (page == ACC_PAGE_PHYSICS && size == sizeof(acc_physics_page)) {
+        physicsCallbacks++;
+    }
+}
+
+static void testCApi(SPageFilePhysics *physics) {
+    CHECK(acc_abi_version() == ACC_ABI_VERSION);
+
+    acc_reader *reader = acc_open("posix", 1);
+    CHECK(reader != nullptr);
+    if (!reader) {
+        cout << acc_last_error() << endl;
+        return;
+    }
+
+    CHECK(acc_is_ready(reader, ACC_PAGE_PHYSICS) == 0);
+    physics->rpms = 7000;
+    physics->packetId = 1;
+    CHECK(acc_is_ready(reader, ACC_PAGE_PHYSICS) == 1);
+
+    acc_physics_page page;
+    CHECK(acc_read_page(reader, ACC_PAGE_PHYSICS, &page, sizeof(page)) == 0);
+    CHECK(page.packetId == 1 && page.rpms == 7000);
+    CHECK(acc_read_page(reader, ACC_PAGE_PHYSICS, &page, sizeof(page) - 1) == -1);
+    CHECK(((const acc_physics_page *) acc_page_data(reader, ACC_PAGE_PHYSICS))->rpms == 7000);
+
+    CHECK(acc_watch(reader, countPacket, nullptr, 500) == 0);
+    sleepMs(10);
+    for (int i = 0; i < 20; i++) {
+        physics->packetId++;
+        sleepMs(5);
+    }
+    acc_unwatch(reader);
+    CHECK(physicsCallbacks >= 15 && physicsCallbacks <= 20);
+
+    acc_close(reader);
+}
+
+static void testFlightRecorderWindow(SPageFilePhysics *physics) {
+    filesystem::path outputDir = filesystem::temp_directory_path() / ("acc_smoke_test_" + to_string(getpid()));
+    filesystem::remove_all(outputDir);
+
+    ACCReader reader("posix");
+    reader.initPhysics();
+    reader.initGraphics();
+
+    // packets at ~200Hz, well below the poll rate
+    FlightRecorder recorder;
+    FlightRecorderConfig config;
+    config.outputDir = outputDir.string();
+    config.preTriggerSeconds = 0.2;
+    config.postTriggerSeconds = 0.1;
+    recorder.start(config, reader);
+
+    for (int i = 0; i < 140; i++) {
+        if (i == 80) {
+            physics->numberOfTyresOut = 3;
+        }
+        physics->packetId++;
+        sleepMs(5);
+    }
+    recorder.stop();
+
+    CHECK(recorder.windowsWritten() == 1);
+    CHECK(recorder.windowsFailed() == 0);
+
+    ifstream in(recorder.lastFile(), ios::binary);
+    CHECK(in.good());
+    if (in.good()) {
+        char header[32];
+        uint32_t frameCount;
+        uint32_t triggerIndex;
+        in.read(header, sizeof(header));
+        memcpy(&frameCount, header + 16, 4);
+        memcpy(&triggerIndex, header + 20, 4);
+        CHECK(memcmp(header, "ACCFRv1", 8) == 0);
+        CHECK(triggerIndex < frameCount);
+
+        vector<double> times(frameCount);
+        vector<int> tyresOut(frameCount);
+        SPageFilePhysics framePhysics;
+        SPageFileGraphic frameGraphics;
+        for (uint32_t i = 0; i < frameCount; i++) {
+            in.read((char *) &times[i], sizeof(double));
+            in.read((char *) &framePhysics, sizeof(framePhysics));
+            in.read((char *) &frameGraphics, sizeof(frameGraphics));
+            tyresOut[i] = framePhysics.numberOfTyresOut;
+        }
+        CHECK(in.good());
+
+        if (in.good() && triggerIndex > 0 && triggerIndex < frameCount) {
+            CHECK(tyresOut[triggerIndex] == 3 && tyresOut[triggerIndex - 1] == 0);
+
+            // bounded by the configured seconds, at most a few packet intervals short or over
+            double pre = times[triggerIndex] - times[0];
+            double post = times[frameCount - 1] - times[triggerIndex];
+            CHECK(pre <= config.preTriggerSeconds && pre >= config.preTriggerSeconds - 0.05);
+            CHECK(post >= config.postTriggerSeconds && post <= config.postTriggerSeconds + 0.05);
+        }
+    }
+
+    filesystem::remove_all(outputDir);
+}
+
+static vector<int> readPacketIds(const filesystem::path &path) {
+    vector<int> packetIds;
+    ifstream in(path, ios::binary);
+    char header[32];
+    uint32_t frameCount = 0;
+    in.read(header, sizeof(header));
+    memcpy(&frameCount, header + 16, 4);
+
+    double time;
+    SPageFilePhysics framePhysics;
+    SPageFileGraphic frameGraphics;
+    for (uint32_t i = 0; i < frameCount && in.good(); i++) {
+        in.read((char *) &time, sizeof(time));
+        in.read((char *) &framePhysics, sizeof(framePhysics));
+        in.read((char *) &frameGraphics, sizeof(frameGraphics));
+        packetIds.push_back(framePhysics.packetId);
+    }
+    CHECK(in.good());
+    return packetIds;
+}
+
+static void testFlightRecorderBackToBack(SPageFilePhysics *physics) {
+    filesystem::path outputDir = filesystem::temp_directory_path() / ("acc_smoke_test_" + to_string(getpid()));
+    filesystem::remove_all(outputDir);
+
+    ACCReader reader("posix");
+    reader.initPhysics();
+    reader.initGraphics();
+
+    // windows larger than one copy chunk, the second one starts while the first is still copied out of the ring
+    FlightRecorder recorder;
+    FlightRecorderConfig config;
+    config.outputDir = outputDir.string();
+    config.preTriggerSeconds = 0.5;
+    config.postTriggerSeconds = 0.1;
+    recorder.start(config, reader);
+
+    for (int i = 0; i < 160; i++) {
+        if (i == 100 || i == 125) {
+            recorder.trigger();
+        }
+        physics->packetId++;
+        sleepMs(5);
+    }
+    recorder.stop();
+
+    CHECK(recorder.windowsWritten() == 2);
+    CHECK(recorder.windowsFailed() == 0);
+
+    vector<vector<int>> windows;
+    for (const filesystem::directory_entry &entry : filesystem::directory_iterator(outputDir)) {
+        windows.push_back(readPacketIds(entry.path()));
+    }
+    CHECK(windows.size() == 2);
+
+    for (const vector<int> &packetIds : windows) {
+        CHECK(packetIds.size() > 64);
+        for (size_t i = 1; i < packetIds.size(); i++) {
+            if (packetIds[i] != packetIds[i - 1] + 1) {
+                cout << "packet " << packetIds[i - 1] + 1 << " missing from the window" << endl;
+                failures++;
+                break;
+            }
+        }
+    }
+
+    filesystem::remove_all(outputDir);
+}
+
+int main() {
+    if (access("/dev/shm/acpmf_physics", F_OK) == 0) {
+        cout << "ACC pages already exist in /dev/shm, not touching a running game or bridge" << endl;
+        return SKIPPED;
+    }
+
+    testReadBeforeInit();
+
+    FakePage physicsPage("acpmf_physics", sizeof(SPageFilePhysics));
+    FakePage graphicsPage("acpmf_graphics", sizeof(SPageFileGraphic));
+    FakePage staticPage("acpmf_static", sizeof(SPageFileStatic));
+    if (!physicsPage.data || !graphicsPage.data || !staticPage.data) {
+        cout << "Creating fake pages in /dev/shm failed" << endl;
+        return 1;
+    }
+    SPageFilePhysics *physics = (SPageFilePhysics *) physicsPage.data;
+
+    testCApi(physics);
+
+    physics->numberOfTyresOut = 0;
+    testFlightRecorderWindow(physics);
+    testFlightRecorderBackToBack(physics);
+
+    if (failures) {
+        cout << failures << " checks failed" << endl;
+        return 1;
+    }
+    cout << "All checks passed" << endl;
+    return 0;
+}